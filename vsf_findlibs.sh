@@ -72,5 +72,10 @@ elif find_func SSL_new ssl.o; then
   echo "-lssl -lcrypto";
 fi
 
+# zlib, for MODE Z
+if find_func deflateInit2_ deflate.o; then
+  echo "-lz";
+fi
+
 exit 0;
 
@@ -0,0 +1,105 @@
+#!/bin/sh
+# Resume test for ssl_ktls=YES. Downloads a file over PROT P with REST at a
+# number of offsets, in both process models and with TLS v1.2 and v1.3, and
+# checks every byte. It also checks the kernel's TLS counters went up, so a
+# silent fallback to OpenSSL doing the encryption counts as a failure.
+# Needs root, curl, openssl and a kernel with the tls module loaded
+# ("modprobe tls"); exits 77 (skipped) without the module.
+#   sh vsf_ktlstest.sh [path/to/vsftpd]
+
+VSFTPD=${1:-./vsftpd}
+PORT=${PORT:-2190}
+
+if [ ! -r /proc/net/tls_stat ]; then
+  echo "vsf_ktlstest: skipped, kernel tls module not loaded"
+  exit 77
+fi
+
+TMP=`mktemp -d /tmp/vsf_ktlstest.XXXXXX` || exit 1
+PID=
+cleanup() { [ -n "$PID" ] && kill $PID 2>/dev/null; rm -rf "$TMP"; }
+trap cleanup EXIT
+trap 'exit 1' INT TERM
+
+mkdir "$TMP/root"
+chmod 755 "$TMP" "$TMP/root"
+# Not a multiple of the record or buffer sizes, so the tail is partial
+head -c 3000017 /dev/urandom > "$TMP/root/file.bin"
+chmod 644 "$TMP/root/file.bin"
+SIZE=3000017
+openssl req -x509 -newkey rsa:2048 -nodes -days 1 -subj /CN=localhost \
+  -keyout "$TMP/key.pem" -out "$TMP/cert.pem" >/dev/null 2>&1 || exit 1
+
+tx_count() {
+  awk '$1 == "TlsTxSw" { print $2 }' /proc/net/tls_stat
+}
+
+start_server() {
+  cat > "$TMP/vsftpd.conf" <<EOF
+listen=YES
+listen_port=$PORT
+anonymous_enable=YES
+anon_root=$TMP/root
+one_process_model=$1
+seccomp_sandbox=YES
+ssl_enable=YES
+ssl_ktls=YES
+allow_anon_ssl=YES
+force_anon_data_ssl=YES
+force_anon_logins_ssl=YES
+require_ssl_reuse=NO
+rsa_cert_file=$TMP/cert.pem
+rsa_private_key_file=$TMP/key.pem
+vsftpd_log_file=$TMP/vsftpd.log
+EOF
+  "$VSFTPD" "$TMP/vsftpd.conf" &
+  PID=$!
+  sleep 1
+}
+
+stop_server() {
+  kill $PID 2>/dev/null
+  wait $PID 2>/dev/null
+  PID=
+}
+
+failed=0
+for model in NO YES; do
+  start_server $model
+  for tls in 1.2 1.3; do
+    before=`tx_count`
+    transfers=0
+    for offset in 0 1 4095 16383 16384 16385 1000000 2999999 \
+                  `expr $SIZE - 1`; do
+      rm -f "$TMP/out"
+      if ! curl -s -S --ssl-reqd -k --tlsv$tls --tls-max $tls \
+             -u anonymous:test -C $offset -o "$TMP/out" \
+             "ftp://127.0.0.1:$PORT/file.bin"; then
+        echo "FAIL one_process_model=$model TLS v$tls offset $offset:" \
+             "transfer failed"
+        failed=1
+        continue
+      fi
+      transfers=`expr $transfers + 1`
+      if ! tail -c +`expr $offset + 1` "$TMP/root/file.bin" |
+           cmp -s - "$TMP/out"; then
+        echo "FAIL one_process_model=$model TLS v$tls offset $offset:" \
+             "wrong data"
+        failed=1
+      fi
+    done
+    after=`tx_count`
+    if [ `expr $after - $before` -lt $transfers ]; then
+      echo "FAIL one_process_model=$model TLS v$tls: only" \
+           "`expr $after - $before` of $transfers data connections used" \
+           "kernel TLS"
+      failed=1
+    fi
+  done
+  stop_server
+done
+
+if [ $failed = 0 ]; then
+  echo "vsf_ktlstest: all passed"
+fi
+exit $failed